@@ -0,0 +1,145 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/* Helpers shared by the benchmarks of the data structures. Every result is
+ * printed as one CSV line:
+ *
+ *   structure,op,distribution,size,ops,ns_per_op,ops_per_sec,peak_rss_kb
+ *
+ * where size is the number of elements in the structure, ops is the number of
+ * timed operations, and peak_rss_kb is the peak resident set size of the
+ * process since the measurement started with bench_start(). Resetting the
+ * peak needs Linux; elsewhere, it is the peak of the whole process so far.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_MAX_SIZE 1000000L
+#define BENCH_MIN_SIZE         1000L
+
+/* The operations that are linear in the size of the structure are repeated
+ * only until they have touched about this many elements in total. */
+#define BENCH_LINEAR_BUDGET    (1L << 26)
+
+static uint64_t bench_rng_state;
+
+static void
+bench_seed (uint64_t seed)
+{
+  /* xorshift64 must not start from 0. */
+  bench_rng_state = seed * 2654435761ULL + 88172645463325252ULL;
+}
+
+static uint64_t
+bench_rng (void)
+{
+  bench_rng_state ^= bench_rng_state << 13;
+  bench_rng_state ^= bench_rng_state >> 7;
+  bench_rng_state ^= bench_rng_state << 17;
+
+  return bench_rng_state;
+}
+
+static double
+bench_get_time_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static long
+bench_get_peak_rss_kb (void)
+{
+  struct rusage usage;
+  char line[256];
+  long peak = -1;
+  FILE *file;
+
+  /* VmHWM is the peak that bench_start() resets, unlike ru_maxrss. */
+  file = fopen ("/proc/self/status", "r");
+  if (file != NULL) {
+    while (fgets (line, sizeof (line), file) != NULL)
+      if (strncmp (line, "VmHWM:", 6) == 0)
+        peak = atol (line + 6);
+
+    fclose (file);
+  }
+
+  if (peak >= 0)
+    return peak;
+
+  if (getrusage (RUSAGE_SELF, &usage) != 0)
+    return -1;
+
+  return usage.ru_maxrss;
+}
+
+/* Starts a measurement: resets the peak RSS to the current RSS, then returns
+ * the current time. */
+static double
+bench_start (void)
+{
+  FILE *file = fopen ("/proc/self/clear_refs", "w");
+
+  if (file != NULL) {
+    fputs ("5", file);
+    fclose (file);
+  }
+
+  return bench_get_time_ns ();
+}
+
+/* The number of repetitions of an operation that is linear in the size. */
+static long
+bench_get_linear_ops (long size)
+{
+  long ops = BENCH_LINEAR_BUDGET / size;
+
+  if (ops < 1)
+    return 1;
+
+  return ops > size ? size : ops;
+}
+
+/* Usage: bench [max_size]. The sizes go from BENCH_MIN_SIZE up to max_size,
+ * multiplying by 10 each time. */
+static long
+bench_get_max_size (int    argc,
+                    char **argv)
+{
+  return argc > 1 ? atol (argv[1]) : BENCH_DEFAULT_MAX_SIZE;
+}
+
+static void
+bench_print_header (void)
+{
+  printf ("structure,op,distribution,size,ops,ns_per_op,ops_per_sec,peak_rss_kb\n");
+}
+
+static void
+bench_report (const char *structure,
+              const char *op,
+              const char *distribution,
+              long        size,
+              long        ops,
+              double      elapsed_ns)
+{
+  /* Avoid dividing by 0 on coarse clocks. */
+  if (elapsed_ns < 1)
+    elapsed_ns = 1;
+
+  printf ("%s,%s,%s,%ld,%ld,%.2f,%.0f,%ld\n",
+          structure, op, distribution, size, ops,
+          elapsed_ns / ops, ops / elapsed_ns * 1e9, bench_get_peak_rss_kb ());
+  fflush (stdout);
+}
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef STATS_H
+#define STATS_H
+
+/* Opt-in instrumentation for the data structures. When ENABLE_STATS is
+ * defined (make STATS=1), every instance keeps counters of the work done by
+ * its operations, and two histograms for every operation: one of the
+ * latencies, which is fed by one call out of 2^STATS_SAMPLE_SHIFT, and one of
+ * the depths of the sifts, for the trees. Otherwise, the macros below expand to
+ * nothing and the instances carry no extra fields.
+ */
+
+#ifdef ENABLE_STATS
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef STATS_SAMPLE_SHIFT
+#define STATS_SAMPLE_SHIFT 6
+#endif
+
+#define STATS_MAX_OPS   16
+/* Bucket i of a histogram counts the latencies in [2^i, 2^(i+1)) ns. */
+#define STATS_N_BUCKETS 40
+/* Bucket 0 of a depth histogram counts the sifts that moved nothing, and
+ * bucket i > 0 the ones that moved an element by [2^(i-1), 2^i) levels. */
+#define STATS_N_DEPTH_BUCKETS 8
+
+/* The traversal steps are the list nodes visited to reach a position or to
+ * find a value, e.g. 1 when the head is enough. */
+typedef enum {
+  STATS_ALLOCATIONS,
+  STATS_TRAVERSAL_STEPS,
+  STATS_COMPARISONS,
+  STATS_SWAPS,
+  STATS_N_COUNTERS
+} StatsCounter;
+
+typedef struct {
+  unsigned long long calls;
+  unsigned long long samples;
+  unsigned long long buckets[STATS_N_BUCKETS];
+  unsigned long long depths[STATS_N_DEPTH_BUCKETS];
+} StatsHistogram;
+
+typedef struct {
+  unsigned long long counters[STATS_N_COUNTERS];
+  StatsHistogram     ops[STATS_MAX_OPS];
+} Stats;
+
+typedef struct {
+  StatsHistogram  *histogram;
+  struct timespec  start;
+} StatsTimer;
+
+static const char *stats_counter_names[STATS_N_COUNTERS] = {
+  "allocations",
+  "traversal_steps",
+  "comparisons",
+  "swaps",
+};
+
+static inline StatsTimer
+stats_timer_start (StatsHistogram *histogram)
+{
+  StatsTimer timer = { NULL };
+
+  /* Only read the clock for the sampled calls. */
+  if ((histogram->calls++ & ((1ULL << STATS_SAMPLE_SHIFT) - 1)) == 0) {
+    timer.histogram = histogram;
+    clock_gettime (CLOCK_MONOTONIC, &timer.start);
+  }
+
+  return timer;
+}
+
+static inline void
+stats_timer_stop (StatsTimer *timer)
+{
+  struct timespec end;
+  unsigned long long ns;
+  int bucket = 0;
+
+  if (timer->histogram == NULL)
+    return;
+
+  clock_gettime (CLOCK_MONOTONIC, &end);
+  ns = (end.tv_sec - timer->start.tv_sec) * 1000000000ULL +
+       end.tv_nsec - timer->start.tv_nsec;
+
+  while (ns > 1 && bucket < STATS_N_BUCKETS - 1) {
+    ns >>= 1;
+    bucket++;
+  }
+
+  timer->histogram->samples++;
+  timer->histogram->buckets[bucket]++;
+}
+
+static inline void
+stats_add_depth (StatsHistogram *histogram,
+                 int             depth)
+{
+  int bucket = 0;
+
+  while (depth > 0 && bucket < STATS_N_DEPTH_BUCKETS - 1) {
+    depth >>= 1;
+    bucket++;
+  }
+
+  histogram->depths[bucket]++;
+}
+
+static void
+stats_merge (Stats *stats,
+             Stats *other)
+{
+  for (int i = 0; i < STATS_N_COUNTERS; i++)
+    stats->counters[i] += other->counters[i];
+
+  for (int i = 0; i < STATS_MAX_OPS; i++) {
+    StatsHistogram *histogram = &stats->ops[i];
+
+    histogram->calls += other->ops[i].calls;
+    histogram->samples += other->ops[i].samples;
+
+    for (int j = 0; j < STATS_N_BUCKETS; j++)
+      histogram->buckets[j] += other->ops[i].buckets[j];
+
+    for (int j = 0; j < STATS_N_DEPTH_BUCKETS; j++)
+      histogram->depths[j] += other->ops[i].depths[j];
+  }
+}
+
+static void
+stats_dump (Stats             *stats,
+            const char *const *op_names,
+            int                n_ops,
+            FILE              *stream)
+{
+  for (int i = 0; i < STATS_N_COUNTERS; i++)
+    fprintf (stream, "counter %s %llu\n",
+             stats_counter_names[i], stats->counters[i]);
+
+  for (int i = 0; i < n_ops; i++) {
+    StatsHistogram *histogram = &stats->ops[i];
+
+    if (histogram->calls == 0)
+      continue;
+
+    fprintf (stream, "op %s calls %llu samples %llu\n",
+             op_names[i], histogram->calls, histogram->samples);
+
+    for (int j = 0; j < STATS_N_BUCKETS; j++)
+      if (histogram->buckets[j] > 0)
+        fprintf (stream, "latency %s %lluns %llu\n",
+                 op_names[i], 1ULL << j, histogram->buckets[j]);
+
+    for (int j = 0; j < STATS_N_DEPTH_BUCKETS; j++)
+      if (histogram->depths[j] > 0)
+        fprintf (stream, "sift_depth %s %llu %llu\n",
+                 op_names[i], j == 0 ? 0ULL : 1ULL << (j - 1), histogram->depths[j]);
+  }
+}
+
+#define STATS_INIT(OBJ) memset (&(OBJ)->stats, 0, sizeof ((OBJ)->stats))
+
+/* The counters are not atomic: code updating them from several threads must
+ * give every thread its own Stats and merge them at the end. */
+#define STATS_ADD(OBJ, COUNTER, N) ((void) ((OBJ)->stats.counters[COUNTER] += (N)))
+
+#define STATS_MERGE(OBJ, OTHER) stats_merge (&(OBJ)->stats, &(OTHER)->stats)
+
+/* Records that a sift of the operation moved an element by DEPTH levels. */
+#define STATS_ADD_DEPTH(OBJ, OP, DEPTH) stats_add_depth (&(OBJ)->stats.ops[OP], (DEPTH))
+
+/* Records the latency of the rest of the enclosing block, up to its exit. */
+#define STATS_TIME_OP(OBJ, OP)                                      \
+  StatsTimer _stats_timer __attribute__ ((cleanup (stats_timer_stop))) = \
+    stats_timer_start (&(OBJ)->stats.ops[OP])
+
+#define STATS_DUMP(OBJ, OP_NAMES, STREAM) \
+  stats_dump (&(OBJ)->stats, (OP_NAMES), sizeof (OP_NAMES) / sizeof ((OP_NAMES)[0]), (STREAM))
+
+#else
+
+#define STATS_INIT(OBJ)                   ((void) 0)
+#define STATS_ADD(OBJ, COUNTER, N)        ((void) 0)
+#define STATS_MERGE(OBJ, OTHER)           ((void) 0)
+#define STATS_ADD_DEPTH(OBJ, OP, DEPTH)   ((void) 0)
+#define STATS_TIME_OP(OBJ, OP)            ((void) 0)
+#define STATS_DUMP(OBJ, OP_NAMES, STREAM) ((void) 0)
+
+#endif
+
+#endif
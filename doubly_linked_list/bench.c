@@ -0,0 +1,245 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "doubly-linked-list.h"
+
+/* Microbenchmarks for the doubly linked list, with a plain array as the
+ * baseline. The lists hold the integers 0...size - 1, in order. The random
+ * distribution picks uniformly distributed positions and values, while the
+ * adversarial one always picks the worst case: the last position, or a value
+ * that is not in the list.
+ *
+ * Usage: bench [max_size]
+ */
+
+#define STRUCTURE "doubly_linked_list"
+
+/* Keeps the compiler from optimizing away the results. */
+static volatile intptr_t sink;
+
+static int
+integer_comparison_func (const void *a,
+                         const void *b)
+{
+  return ((intptr_t) a > (intptr_t) b) - ((intptr_t) a < (intptr_t) b);
+}
+
+static DoublyLinkedList *
+new_list (long size)
+{
+  DoublyLinkedList *list = doubly_linked_list_new (integer_comparison_func);
+
+  for (long i = 0; i < size; i++)
+    doubly_linked_list_append (list, (void *) (intptr_t) i);
+
+  return list;
+}
+
+static long
+get_position (long size,
+              int  adversarial)
+{
+  return adversarial ? size - 1 : (long) (bench_rng () % size);
+}
+
+static intptr_t
+get_value (long size,
+           int  adversarial)
+{
+  return adversarial ? -1 : (intptr_t) (bench_rng () % size);
+}
+
+static void
+bench_append_and_destroy (long size)
+{
+  DoublyLinkedList *list;
+  double start;
+
+  start = bench_start ();
+  list = new_list (size);
+  bench_report (STRUCTURE, "append", "sequential", size, size,
+                bench_get_time_ns () - start);
+
+  start = bench_start ();
+  doubly_linked_list_destroy (list);
+  bench_report (STRUCTURE, "destroy", "sequential", size, size,
+                bench_get_time_ns () - start);
+}
+
+static void
+bench_prepend (long size)
+{
+  DoublyLinkedList *list = doubly_linked_list_new (integer_comparison_func);
+  double start;
+
+  start = bench_start ();
+  for (long i = 0; i < size; i++)
+    doubly_linked_list_prepend (list, (void *) (intptr_t) i);
+  bench_report (STRUCTURE, "prepend", "sequential", size, size,
+                bench_get_time_ns () - start);
+
+  doubly_linked_list_destroy (list);
+}
+
+static void
+bench_insert_at (long size,
+                 int  adversarial)
+{
+  DoublyLinkedList *list = new_list (size);
+  long ops = bench_get_linear_ops (size);
+  double start;
+
+  start = bench_start ();
+  for (long i = 0; i < ops; i++)
+    doubly_linked_list_insert_at (list, (void *) (intptr_t) i,
+                                  get_position (size, adversarial));
+  bench_report (STRUCTURE, "insert_at", adversarial ? "adversarial" : "random",
+                size, ops, bench_get_time_ns () - start);
+
+  doubly_linked_list_destroy (list);
+}
+
+static void
+bench_get (DoublyLinkedList *list,
+           long              size,
+           int               adversarial)
+{
+  long ops = bench_get_linear_ops (size);
+  double start;
+
+  start = bench_start ();
+  for (long i = 0; i < ops; i++)
+    sink += (intptr_t) doubly_linked_list_get (list, get_position (size, adversarial));
+  bench_report (STRUCTURE, "get", adversarial ? "adversarial" : "random",
+                size, ops, bench_get_time_ns () - start);
+}
+
+static void
+bench_index_of (DoublyLinkedList *list,
+                long              size,
+                int               adversarial)
+{
+  long ops = bench_get_linear_ops (size);
+  double start;
+
+  start = bench_start ();
+  for (long i = 0; i < ops; i++)
+    sink += doubly_linked_list_index_of (list, (void *) get_value (size, adversarial));
+  bench_report (STRUCTURE, "index_of", adversarial ? "adversarial" : "random",
+                size, ops, bench_get_time_ns () - start);
+}
+
+static void
+bench_remove (DoublyLinkedList *list,
+              long              size,
+              int               adversarial)
+{
+  long ops = bench_get_linear_ops (size);
+  double start;
+
+  /* Every removed value is appended back, so that the size stays the same. */
+  start = bench_start ();
+  for (long i = 0; i < ops; i++) {
+    void *data = (void *) get_value (size, adversarial);
+
+    if (doubly_linked_list_remove (list, data))
+      doubly_linked_list_append (list, data);
+  }
+  bench_report (STRUCTURE, "remove", adversarial ? "adversarial" : "random",
+                size, ops, bench_get_time_ns () - start);
+}
+
+static void
+bench_reverse (DoublyLinkedList *list,
+               long              size)
+{
+  long ops = bench_get_linear_ops (size);
+  double start;
+
+  start = bench_start ();
+  for (long i = 0; i < ops; i++)
+    doubly_linked_list_reverse (list);
+  bench_report (STRUCTURE, "reverse", "sequential", size, ops,
+                bench_get_time_ns () - start);
+}
+
+static void
+bench_array (long size)
+{
+  long ops = bench_get_linear_ops (size);
+  long capacity = 0;
+  intptr_t *array = NULL;
+  double start;
+
+  /* Append with geometric growth, like a typical dynamic array. */
+  start = bench_start ();
+  for (long i = 0; i < size; i++) {
+    if (i == capacity) {
+      capacity = capacity == 0 ? 16 : 2 * capacity;
+      array = realloc (array, capacity * sizeof (intptr_t));
+    }
+    array[i] = i;
+  }
+  bench_report ("array", "append", "sequential", size, size,
+                bench_get_time_ns () - start);
+
+  for (int adversarial = 0; adversarial <= 1; adversarial++) {
+    const char *distribution = adversarial ? "adversarial" : "random";
+
+    start = bench_start ();
+    for (long i = 0; i < ops; i++)
+      sink += array[get_position (size, adversarial)];
+    bench_report ("array", "get", distribution, size, ops,
+                  bench_get_time_ns () - start);
+
+    start = bench_start ();
+    for (long i = 0; i < ops; i++) {
+      intptr_t value = get_value (size, adversarial);
+      long j;
+
+      for (j = 0; j < size && array[j] != value; j++);
+      sink += j;
+    }
+    bench_report ("array", "index_of", distribution, size, ops,
+                  bench_get_time_ns () - start);
+  }
+
+  free (array);
+}
+
+int main (int argc, char **argv)
+{
+  long max_size = bench_get_max_size (argc, argv);
+
+  bench_print_header ();
+
+  for (long size = BENCH_MIN_SIZE; size <= max_size; size *= 10) {
+    DoublyLinkedList *list;
+
+    bench_seed (size);
+
+    bench_append_and_destroy (size);
+    bench_prepend (size);
+
+    for (int adversarial = 0; adversarial <= 1; adversarial++)
+      bench_insert_at (size, adversarial);
+
+    list = new_list (size);
+
+    for (int adversarial = 0; adversarial <= 1; adversarial++) {
+      bench_get (list, size, adversarial);
+      bench_index_of (list, size, adversarial);
+      bench_remove (list, size, adversarial);
+    }
+
+    bench_reverse (list, size);
+
+    doubly_linked_list_destroy (list);
+
+    bench_array (size);
+  }
+
+  return 0;
+}
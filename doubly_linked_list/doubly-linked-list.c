@@ -2,8 +2,33 @@
 #include <stdlib.h>
 
 #include "doubly-linked-list.h"
+#include "stats.h"
 #include "utils.h"
 
+#ifdef ENABLE_STATS
+typedef enum {
+  OP_PREPEND,
+  OP_APPEND,
+  OP_INSERT_AT,
+  OP_REMOVE,
+  OP_REMOVE_AT,
+  OP_GET,
+  OP_INDEX_OF,
+  OP_REVERSE,
+} Op;
+
+static const char *op_names[] = {
+  "prepend",
+  "append",
+  "insert_at",
+  "remove",
+  "remove_at",
+  "get",
+  "index_of",
+  "reverse",
+};
+#endif
+
 struct _Node {
   Node *next;
   Node *prev;
@@ -16,6 +41,9 @@ struct _DoublyLinkedList {
   long             length;
   DataCompareFunc  compare;
   DataDestroyFunc  destroy;
+#ifdef ENABLE_STATS
+  Stats            stats;
+#endif
 };
 
 static Node *
@@ -98,6 +126,9 @@ doubly_linked_list_new_full (DataCompareFunc cmp_func,
   list->compare = cmp_func;
   list->destroy = destroy_func;
 
+  STATS_INIT (list);
+  STATS_ADD (list, STATS_ALLOCATIONS, 1);
+
   return list;
 }
 
@@ -151,8 +182,11 @@ doubly_linked_list_prepend (DoublyLinkedList *list,
   if (list == NULL)
     return;
 
+  STATS_TIME_OP (list, OP_PREPEND);
+
   /* Create a new node. */
   node = node_new (data);
+  STATS_ADD (list, STATS_ALLOCATIONS, 1);
 
   /* Set the new pointers accordingly. */
   if (list->length == 0) {
@@ -184,8 +218,11 @@ doubly_linked_list_append (DoublyLinkedList *list,
   if (list == NULL)
     return;
 
+  STATS_TIME_OP (list, OP_APPEND);
+
   /* Create a new node. */
   node = node_new (data);
+  STATS_ADD (list, STATS_ALLOCATIONS, 1);
 
   /* Set the new pointers accordingly. */
   if (list->length == 0) {
@@ -223,6 +260,10 @@ doubly_linked_list_insert_at (DoublyLinkedList *list,
   if (list == NULL)
     return;
 
+  /* Started before the hand-offs below, so that every call is counted as an
+   * insert_at call, and also as an append or prepend call when handed off. */
+  STATS_TIME_OP (list, OP_INSERT_AT);
+
   /* In case of an invalid position, append to the end of the list. */
   if (position < 0 || position >= list->length) {
     doubly_linked_list_append (list, data);
@@ -237,9 +278,11 @@ doubly_linked_list_insert_at (DoublyLinkedList *list,
 
   /* Create a new node with the given data. */
   node = node_new (data);
+  STATS_ADD (list, STATS_ALLOCATIONS, 1);
 
   /* Iterate over the list and retrieve the node at position - 1. */
   for (i = 0, tmp = list->head; i < position - 1; i++, tmp = tmp->next);
+  STATS_ADD (list, STATS_TRAVERSAL_STEPS, i + 1);
 
   /* Set the new pointers accordingly. */
   node->next = tmp->next;
@@ -269,6 +312,9 @@ doubly_linked_list_reverse (DoublyLinkedList *list)
   if (list == NULL)
     return;
 
+  STATS_TIME_OP (list, OP_REVERSE);
+  STATS_ADD (list, STATS_TRAVERSAL_STEPS, list->length);
+
   /* Save the initial head and tail. */
   head = list->head;
   tail = list->tail;
@@ -308,8 +354,13 @@ doubly_linked_list_remove (DoublyLinkedList *list,
   if (list == NULL || list->length == 0)
     return FALSE;
 
+  STATS_TIME_OP (list, OP_REMOVE);
+
   /* Iterate over the list and compare the data stored in every node. */
   for (node = list->head; node != NULL; node = node->next) {
+    STATS_ADD (list, STATS_TRAVERSAL_STEPS, 1);
+    STATS_ADD (list, STATS_COMPARISONS, 1);
+
     /* Remove the first node that contains the given data. */
     if (list->compare (node->data, data) == 0) {
       doubly_linked_list_remove_existing_node (list, node);
@@ -373,8 +424,11 @@ doubly_linked_list_remove_at (DoublyLinkedList *list,
   if (list == NULL || position >= list->length)
     return FALSE;
 
+  STATS_TIME_OP (list, OP_REMOVE_AT);
+
   /* Retrieve the node at the given position. */
   for (i = 0, node = list->head; i < position; i++, node = node->next);
+  STATS_ADD (list, STATS_TRAVERSAL_STEPS, i + 1);
 
   /* Remove the node from the list. */
   doubly_linked_list_remove_existing_node (list, node);
@@ -404,8 +458,11 @@ doubly_linked_list_get (DoublyLinkedList *list,
   if (list == NULL || position >= list->length)
     return NULL;
 
+  STATS_TIME_OP (list, OP_GET);
+
   /* Retrieve the node at the given position. */
   for (i = 0, node = list->head; i < position; i++, node = node->next);
+  STATS_ADD (list, STATS_TRAVERSAL_STEPS, i + 1);
 
   return node->data;
 }
@@ -434,14 +491,40 @@ doubly_linked_list_index_of (DoublyLinkedList *list,
   if (list == NULL)
     return -1;
 
+  STATS_TIME_OP (list, OP_INDEX_OF);
+
   /* Iterate over the list and return the index where the data is found. */
-  for (node = list->head, index = 0; node != NULL; node = node->next, index++)
+  for (node = list->head, index = 0; node != NULL; node = node->next, index++) {
+    STATS_ADD (list, STATS_TRAVERSAL_STEPS, 1);
+    STATS_ADD (list, STATS_COMPARISONS, 1);
+
     if (list->compare (node->data, data) == 0)
       return index;
+  }
 
   return -1;
 }
 
+/**
+ * doubly_linked_list_dump_stats:
+ * @list: A list.
+ * @stream: The stream to write to.
+ *
+ * Writes the operation counters and the sampled latency histograms of the
+ * list, one per line. This does nothing unless the list was built with
+ * ENABLE_STATS defined.
+ */
+void
+doubly_linked_list_dump_stats (DoublyLinkedList *list,
+                               FILE             *stream)
+{
+  /* Sanity check. */
+  if (list == NULL)
+    return;
+
+  STATS_DUMP (list, op_names, stream);
+}
+
 /**
  * doubly_linked_list_destroy:
  * @list: A list.
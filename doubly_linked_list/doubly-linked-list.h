@@ -1,6 +1,8 @@
 #ifndef DOUBLY_LINKED_LIST_H
 #define DOUBLY_LINKED_LIST_H
 
+#include <stdio.h>
+
 #define FALSE (0)
 #define TRUE  (!FALSE)
 
@@ -35,6 +37,8 @@ void             *doubly_linked_list_get        (DoublyLinkedList *list,
 int               doubly_linked_list_index_of   (DoublyLinkedList *list,
                                                  void             *data);
 void              doubly_linked_list_reverse    (DoublyLinkedList *list);
+void              doubly_linked_list_dump_stats (DoublyLinkedList *list,
+                                                 FILE             *stream);
 void              doubly_linked_list_destroy    (DoublyLinkedList *list);
 
 #endif
@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "doubly-linked-list.h"
 
@@ -11,6 +12,72 @@ integer_comparison_func (const void *a,
   return ((intptr_t) a) - ((intptr_t) b);
 }
 
+#ifdef ENABLE_STATS
+/* Gets the number that follows the prefix in the dump of the list stats, or 0
+ * if no line starts with it, e.g. "counter comparisons ". */
+static unsigned long long
+get_stat (DoublyLinkedList *list,
+          const char       *prefix)
+{
+  FILE *stream = tmpfile ();
+  unsigned long long value = 0;
+  char line[256];
+
+  assert (stream != NULL);
+
+  doubly_linked_list_dump_stats (list, stream);
+  rewind (stream);
+
+  while (fgets (line, sizeof (line), stream) != NULL)
+    if (strncmp (line, prefix, strlen (prefix)) == 0)
+      sscanf (line + strlen (prefix), "%llu", &value);
+
+  fclose (stream);
+
+  return value;
+}
+
+static void
+stats_check (void)
+{
+  DoublyLinkedList *list = doubly_linked_list_new (integer_comparison_func);
+  unsigned long long steps;
+  unsigned long long comparisons;
+  unsigned long long insert_at_calls;
+
+  for (intptr_t i = 0; i < 5; i++)
+    doubly_linked_list_append (list, (void *) i);
+  assert (get_stat (list, "counter allocations ") == 6);
+
+  /* Reaching a position visits the nodes up to it, included. */
+  steps = get_stat (list, "counter traversal_steps ");
+  doubly_linked_list_get (list, 2);
+  assert (get_stat (list, "counter traversal_steps ") == steps + 3);
+  doubly_linked_list_get (list, 0);
+  assert (get_stat (list, "counter traversal_steps ") == steps + 4);
+
+  /* Looking for a missing value visits and compares every node. */
+  steps = get_stat (list, "counter traversal_steps ");
+  comparisons = get_stat (list, "counter comparisons ");
+  assert (doubly_linked_list_index_of (list, (void *) (intptr_t) 100) == -1);
+  assert (get_stat (list, "counter traversal_steps ") == steps + 5);
+  assert (get_stat (list, "counter comparisons ") == comparisons + 5);
+
+  /* The calls handed off to prepend or append still count as insert_at
+   * calls. */
+  insert_at_calls = get_stat (list, "op insert_at calls ");
+  doubly_linked_list_insert_at (list, (void *) (intptr_t) 7, 0);
+  doubly_linked_list_insert_at (list, (void *) (intptr_t) 8, 100);
+  doubly_linked_list_insert_at (list, (void *) (intptr_t) 9, 2);
+  assert (get_stat (list, "op insert_at calls ") == insert_at_calls + 3);
+  assert (get_stat (list, "op prepend calls ") == 1);
+  assert (get_stat (list, "op append calls ") == 6);
+  assert (get_stat (list, "counter allocations ") == 9);
+
+  doubly_linked_list_destroy (list);
+}
+#endif
+
 int main (int argc, char **argv)
 {
   DoublyLinkedList *list;
@@ -55,7 +122,14 @@ int main (int argc, char **argv)
   assert ((intptr_t) doubly_linked_list_get (list, 0) == 1);
   assert ((intptr_t) doubly_linked_list_get (list, 1) == 3);
 
+  /* Prints nothing unless built with "make STATS=1". */
+  doubly_linked_list_dump_stats (list, stdout);
+
   doubly_linked_list_destroy (list);
 
+#ifdef ENABLE_STATS
+  stats_check ();
+#endif
+
   return 0;
 }
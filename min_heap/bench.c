@@ -0,0 +1,189 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "min-heap.h"
+
+/* Microbenchmarks for the min heap, with qsort() and a plain unsorted array
+ * as the baselines. The keys are either random, ascending (the best case) or
+ * descending (the adversarial case, where every insert sifts up to the root).
+ *
+ * Usage: bench [max_size]
+ */
+
+#define STRUCTURE "min_heap"
+
+static const char *distributions[] = {
+  "random",
+  "ascending",
+  "descending",
+};
+
+#define N_DISTRIBUTIONS ((int) (sizeof (distributions) / sizeof (distributions[0])))
+
+/* Keeps the compiler from optimizing away the results. */
+static volatile int sink;
+
+static int
+integer_comparison_func (const void *a,
+                         const void *b)
+{
+  return (*(const int *) a > *(const int *) b) - (*(const int *) a < *(const int *) b);
+}
+
+static int *
+new_keys (long size,
+          int  distribution)
+{
+  int *keys = malloc (size * sizeof (int));
+
+  for (long i = 0; i < size; i++) {
+    switch (distribution) {
+    case 0:
+      keys[i] = bench_rng () >> 33;
+      break;
+    case 1:
+      keys[i] = i;
+      break;
+    default:
+      keys[i] = size - i;
+      break;
+    }
+  }
+
+  return keys;
+}
+
+static void
+bench_insert_and_pop (int  *keys,
+                      long  size,
+                      int   distribution)
+{
+  MinHeap *heap = min_heap_new (size);
+  double start;
+
+  start = bench_start ();
+  for (long i = 0; i < size; i++)
+    min_heap_insert (heap, keys[i]);
+  bench_report (STRUCTURE, "insert", distributions[distribution], size, size,
+                bench_get_time_ns () - start);
+
+  start = bench_start ();
+  for (long i = 0; i < size; i++)
+    sink += min_heap_pop (heap);
+  bench_report (STRUCTURE, "pop", distributions[distribution], size, size,
+                bench_get_time_ns () - start);
+
+  min_heap_free (heap);
+}
+
+static void
+bench_build (int  *keys,
+             long  size,
+             int   distribution)
+{
+  MinHeap *heap;
+  int *copy;
+  double start;
+
+  start = bench_start ();
+  heap = min_heap_new_from_array (keys, size);
+  bench_report (STRUCTURE, "build", distributions[distribution], size, size,
+                bench_get_time_ns () - start);
+
+  min_heap_free (heap);
+
+  /* Copying the keys is the lower bound of any build. */
+  start = bench_start ();
+  copy = malloc (size * sizeof (int));
+  memcpy (copy, keys, size * sizeof (int));
+  sink += copy[size - 1];
+  bench_report ("array", "build", distributions[distribution], size, size,
+                bench_get_time_ns () - start);
+
+  free (copy);
+}
+
+static void
+bench_sort (int  *keys,
+            long  size,
+            int   distribution)
+{
+  int *copy = malloc (size * sizeof (int));
+  double start;
+
+  memcpy (copy, keys, size * sizeof (int));
+  start = bench_start ();
+  min_heap_sort_array (copy, size);
+  bench_report (STRUCTURE, "sort", distributions[distribution], size, size,
+                bench_get_time_ns () - start);
+
+  memcpy (copy, keys, size * sizeof (int));
+  start = bench_start ();
+  qsort (copy, size, sizeof (int), integer_comparison_func);
+  bench_report ("qsort", "sort", distributions[distribution], size, size,
+                bench_get_time_ns () - start);
+
+  free (copy);
+}
+
+static void
+bench_array (int  *keys,
+             long  size,
+             int   distribution)
+{
+  /* An unsorted array has O(1) insert, but O(n) pop. */
+  long ops = bench_get_linear_ops (size);
+  int *array = malloc (size * sizeof (int));
+  long length = 0;
+  double start;
+
+  start = bench_start ();
+  for (long i = 0; i < size; i++)
+    array[length++] = keys[i];
+  sink += array[size - 1];
+  bench_report ("array", "insert", distributions[distribution], size, size,
+                bench_get_time_ns () - start);
+
+  start = bench_start ();
+  for (long i = 0; i < ops; i++) {
+    long min = 0;
+
+    for (long j = 1; j < length; j++)
+      if (array[j] < array[min])
+        min = j;
+
+    sink += array[min];
+    array[min] = array[--length];
+  }
+  bench_report ("array", "pop", distributions[distribution], size, ops,
+                bench_get_time_ns () - start);
+
+  free (array);
+}
+
+int main (int argc, char **argv)
+{
+  long max_size = bench_get_max_size (argc, argv);
+
+  bench_print_header ();
+
+  for (long size = BENCH_MIN_SIZE; size <= max_size; size *= 10) {
+    bench_seed (size);
+
+    for (int distribution = 0; distribution < N_DISTRIBUTIONS; distribution++) {
+      int *keys = new_keys (size, distribution);
+
+      bench_insert_and_pop (keys, size, distribution);
+      bench_build (keys, size, distribution);
+      bench_sort (keys, size, distribution);
+      bench_array (keys, size, distribution);
+
+      free (keys);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "min-heap.h"
+#include "min-heap-private.h"
+
+/* Measures how min_heap_new_from_array_parallel() scales with the number of
+ * threads, against the serial min_heap_new_from_array().
+ *
+ * Usage: build-bench [size] [max_threads]
+ */
+
+#define DEFAULT_SIZE 100000000
+
+/* Checks the heap property on every node, not just the root. */
+static int
+min_heap_is_valid (MinHeap *heap)
+{
+  for (long i = 1; i < heap->size; i++)
+    if (heap->elems[(i - 1) / 2] > heap->elems[i])
+      return 0;
+
+  return 1;
+}
+
+static double
+run (int *array,
+     int  size,
+     int  n_threads,
+     int  min)
+{
+  MinHeap *heap;
+  double start;
+  double elapsed;
+
+  start = bench_get_time_ns ();
+  if (n_threads == 0)
+    heap = min_heap_new_from_array (array, size);
+  else
+    heap = min_heap_new_from_array_parallel (array, size, n_threads);
+  elapsed = bench_get_time_ns () - start;
+
+  if (min_heap_peek (heap) != min || !min_heap_is_valid (heap)) {
+    fprintf (stderr, "invalid heap with %d threads\n", n_threads);
+    exit (EXIT_FAILURE);
+  }
+
+  min_heap_free (heap);
+
+  return elapsed;
+}
+
+int main (int argc, char **argv)
+{
+  int size = argc > 1 ? atoi (argv[1]) : DEFAULT_SIZE;
+  int max_threads = argc > 2 ? atoi (argv[2]) : sysconf (_SC_NPROCESSORS_ONLN);
+  int *array;
+  int min = -1;
+  double serial;
+
+  array = malloc ((long) size * sizeof (int));
+
+  bench_seed (0);
+
+  for (int i = 0; i < size; i++) {
+    array[i] = bench_rng () >> 33;
+
+    if (i == 0 || array[i] < min)
+      min = array[i];
+  }
+
+  serial = run (array, size, 0, min);
+  printf ("size=%d threads=serial time=%.1fms speedup=1.00\n", size, serial / 1e6);
+
+  /* Double the number of threads each time, ending with max_threads. */
+  for (int n_threads = 1; n_threads <= max_threads;
+       n_threads = n_threads < max_threads && n_threads * 2 > max_threads ? max_threads : n_threads * 2) {
+    double elapsed = run (array, size, n_threads, min);
+
+    printf ("size=%d threads=%d time=%.1fms speedup=%.2f\n",
+            size, n_threads, elapsed / 1e6, serial / elapsed);
+  }
+
+  free (array);
+
+  return 0;
+}
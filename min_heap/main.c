@@ -1,10 +1,164 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "min-heap.h"
+#include "radix-heap.h"
+#include "shm-min-heap.h"
+#include "timer-wheel.h"
+
+typedef struct {
+  uint64_t  deadline;
+  int       fired;
+  Timer    *timer;
+} TimerCheck;
+
+static TimerWheel *wheel;
+
+static void
+timer_check_fired (void *data)
+{
+  ((TimerCheck *) data)->fired++;
+}
+
+static void
+timer_check_rearm (void *data)
+{
+  TimerCheck *check = data;
+
+  /* Cancelling the timer that is firing does nothing. */
+  timer_wheel_cancel (wheel, check->timer);
+
+  check->fired++;
+  check->deadline += 10;
+  check->timer = timer_wheel_schedule (wheel, check->deadline,
+                                       timer_check_fired, check);
+}
+
+/* Checks that the timer fires exactly at its deadline. */
+static void
+timer_check_expiry (TimerCheck *check)
+{
+  int fired = check->fired;
+
+  timer_wheel_advance (wheel, check->deadline - 1);
+  assert (check->fired == fired);
+
+  timer_wheel_advance (wheel, check->deadline);
+  assert (check->fired == fired + 1);
+}
+
+static void
+timer_wheel_check (void)
+{
+  /* One timer on every level, starting from tick 1000, and one overflowing. */
+  TimerCheck checks[] = {
+    { 1005, 0, NULL },
+    { 1300, 0, NULL },
+    { 71000, 0, NULL },
+    { 1000 + (1ULL << 25), 0, NULL },
+    { 1000 + (1ULL << 32) + 7, 0, NULL },
+  };
+  int n = sizeof (checks) / sizeof (checks[0]);
+  TimerCheck cancelled = { 80000, 0, NULL };
+  TimerCheck rearmed = { 1100, 0, NULL };
+
+  wheel = timer_wheel_new (1000);
+
+  for (int i = 0; i < n; i++)
+    checks[i].timer = timer_wheel_schedule (wheel, checks[i].deadline,
+                                            timer_check_fired, &checks[i]);
+
+  cancelled.timer = timer_wheel_schedule (wheel, cancelled.deadline,
+                                          timer_check_fired, &cancelled);
+  rearmed.timer = timer_wheel_schedule (wheel, rearmed.deadline,
+                                        timer_check_rearm, &rearmed);
+  assert (timer_wheel_get_size (wheel) == n + 2);
+
+  timer_wheel_cancel (wheel, cancelled.timer);
+  assert (timer_wheel_get_size (wheel) == n + 1);
+
+  timer_check_expiry (&checks[0]);
+
+  /* The timer re-arms itself 10 ticks later. */
+  timer_check_expiry (&rearmed);
+  assert (timer_wheel_get_size (wheel) == n);
+  timer_check_expiry (&rearmed);
+  assert (timer_wheel_get_size (wheel) == n - 1);
+
+  for (int i = 1; i < n; i++)
+    timer_check_expiry (&checks[i]);
+
+  assert (cancelled.fired == 0);
+  assert (timer_wheel_get_size (wheel) == 0);
+
+  timer_wheel_free (wheel);
+}
+
+/* Checks the radix heap against the binary heap, on interleaved inserts and
+ * pops of monotone keys: first negative ones, then ones close to INT_MAX. The
+ * offsets over the last popped key are often 0, so that bucket 0 holds several
+ * equal keys. */
+static void
+radix_heap_check (void)
+{
+  static const int offsets[] = { 0, 0, 1, 2, 15, 300, 70000 };
+  int bases[] = { -1000000, INT_MAX - 100000 };
+  int max_size = 1000;
+  unsigned int seed = 1;
+
+  for (int b = 0; b < 2; b++) {
+    RadixHeap *radix = radix_heap_new (max_size);
+    MinHeap *ref = min_heap_new (max_size);
+    int last = bases[b];
+
+    for (int step = 0; step < 5000; step++) {
+      int size = min_heap_get_size (ref);
+
+      seed = seed * 1103515245 + 12345;
+
+      /* Pop a little less often than insert, so that the heaps grow. */
+      if (size > 0 && ((seed >> 16) % 5 < 2 || size == max_size)) {
+        int data = min_heap_pop (ref);
+
+        assert (radix_heap_pop (radix) == data);
+        last = data;
+      } else {
+        int offset = offsets[(seed >> 20) % (sizeof (offsets) / sizeof (offsets[0]))];
+        int data = offset > INT_MAX - last ? INT_MAX : last + offset;
+
+        radix_heap_insert (radix, data);
+        min_heap_insert (ref, data);
+      }
+
+      assert (radix_heap_get_size (radix) == min_heap_get_size (ref));
+
+      /* Only peek every other step, so that the pops run both with and
+       * without a cached minimum. */
+      if (min_heap_get_size (ref) > 0 && (seed >> 24) % 2)
+        assert (radix_heap_peek (radix) == min_heap_peek (ref));
+    }
+
+    while (min_heap_get_size (ref) > 0) {
+      assert (radix_heap_peek (radix) == min_heap_peek (ref));
+      assert (radix_heap_pop (radix) == min_heap_pop (ref));
+    }
+
+    assert (radix_heap_get_size (radix) == 0);
+    assert (radix_heap_peek (radix) == -1);
+
+    radix_heap_free (radix);
+    min_heap_free (ref);
+  }
+}
 
 int main(int argc, char **argv)
 {
   int v[] = {8, 4, 2, 5, 1, 3, 7, 6};
+  int w[] = {8, -4, 2, 5, 1, -3, 7, 6};
   int n = sizeof (v) / sizeof (v[0]);
 
   min_heap_sort_array (v, n);
@@ -13,5 +167,82 @@ int main(int argc, char **argv)
     printf("%d ", v[i]);
   printf("\n");
 
+  radix_heap_sort_array (w, n);
+
+  for (int i = 0; i < n; i++)
+    printf("%d ", w[i]);
+  printf("\n");
+
+  radix_heap_check ();
+  timer_wheel_check ();
+
+  /* A child process fills half of a shared heap, then the parent the other
+   * half, and finally the parent empties it. */
+  ShmMinHeap *shared;
+  pid_t pid;
+  int status;
+
+  /* Start from an empty heap, even if a previous run was interrupted. */
+  shm_min_heap_unlink ("/min-heap-demo");
+
+  shared = shm_min_heap_open ("/min-heap-demo", n);
+  if (shared == NULL) {
+    perror ("shm_min_heap_open");
+    return 1;
+  }
+
+  /* Otherwise, the child would print the buffered output a second time. */
+  fflush (stdout);
+
+  pid = fork ();
+  if (pid < 0) {
+    perror ("fork");
+    shm_min_heap_close (shared);
+    shm_min_heap_unlink ("/min-heap-demo");
+    return 1;
+  }
+
+  if (pid == 0) {
+    /* Open the heap by name, like an unrelated process would, instead of
+     * using the inherited one. Since the inherited mapping is still there at
+     * that point, the heap gets mapped at another address, and unmapping the
+     * inherited one leaves nothing at the address the parent uses. */
+    ShmMinHeap *child = shm_min_heap_open ("/min-heap-demo", n);
+
+    shm_min_heap_close (shared);
+
+    if (child == NULL)
+      _exit (1);
+
+    for (int i = 0; i < n; i += 2)
+      if (shm_min_heap_insert (child, v[i]) < 0)
+        _exit (1);
+
+    shm_min_heap_close (child);
+    _exit (0);
+  }
+
+  assert (waitpid (pid, &status, 0) == pid);
+  assert (WIFEXITED (status) && WEXITSTATUS (status) == 0);
+
+  for (int i = 1; i < n; i += 2)
+    assert (shm_min_heap_insert (shared, v[i]) == 0);
+
+  /* v is sorted, so the heap must give it back in the same order. */
+  assert (shm_min_heap_get_size (shared) == n);
+
+  for (int i = 0; i < n; i++) {
+    int data = shm_min_heap_pop (shared);
+
+    assert (data == v[i]);
+    printf("%d ", data);
+  }
+  printf("\n");
+
+  assert (shm_min_heap_get_size (shared) == 0);
+
+  shm_min_heap_close (shared);
+  shm_min_heap_unlink ("/min-heap-demo");
+
   return 0;
 }
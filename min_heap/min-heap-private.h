@@ -0,0 +1,20 @@
+#ifndef MIN_HEAP_PRIVATE_H
+#define MIN_HEAP_PRIVATE_H
+
+#include "min-heap.h"
+#include "stats.h"
+
+/* Only meant for the heaps of this directory that embed a MinHeap, such as
+ * ShmMinHeap. */
+struct _MinHeap {
+  int max_size;
+  int size;
+  int *elems;
+#ifdef ENABLE_STATS
+  Stats stats;
+#endif
+};
+
+void min_heap_rebuild (MinHeap *heap);
+
+#endif
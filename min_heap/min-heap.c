@@ -1,7 +1,11 @@
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "min-heap.h"
+#include "min-heap-private.h"
+#include "stats.h"
 
 /* Given a node with id == k (k = 0...n) then:
  * the id of the left child is 2k + 1.
@@ -11,13 +15,45 @@
 
 #define GET_PARENT_ID(ID) ((ID + 1) / 2 - 1)
 
-struct _MinHeap {
-  int max_size;
-  int size;
-  int *elems;
-};
+/* Below this size, the parallel build is not worth the thread startup. */
+#define PARALLEL_BUILD_MIN_SIZE (1 << 16)
+
+/* The parallel build hands out this many subtrees per thread, so that the
+ * threads that get the shallower subtrees of the last level can balance the
+ * load a little. */
+#define PARALLEL_BUILD_SUBTREES_PER_THREAD 4
+
+/* More threads than this would only fight over the memory bandwidth. */
+#define PARALLEL_BUILD_MAX_THREADS 1024
 
-static void
+#ifdef ENABLE_STATS
+typedef enum {
+  OP_BUILD,
+  OP_INSERT,
+  OP_POP,
+} Op;
+
+static const char *op_names[] = {
+  "build",
+  "insert",
+  "pop",
+};
+#endif
+
+typedef struct {
+  /* A private copy of the heap header, so that every thread updates its own
+   * counters. */
+  MinHeap    heap;
+  int       *array;
+  /* The roots of the subtrees to build, all on the same level. */
+  int        first_root;
+  int        last_root;
+  pthread_t  thread;
+  int        started;
+} BuildTask;
+
+/* Returns the number of levels the node was moved down. */
+static int
 min_heap_heapify (MinHeap *heap,
                   int      id)
 {
@@ -25,6 +61,8 @@ min_heap_heapify (MinHeap *heap,
   int right = 2 * id + 2;
   int min = id;
 
+  STATS_ADD (heap, STATS_COMPARISONS, (left < heap->size) + (right < heap->size));
+
   /* Get min (node, left child). */
   if (left < heap->size && heap->elems[left] < heap->elems[id])
     min = left;
@@ -40,9 +78,52 @@ min_heap_heapify (MinHeap *heap,
     heap->elems[id] = heap->elems[min];
     heap->elems[min] = tmp;
 
+    STATS_ADD (heap, STATS_SWAPS, 1);
+
     /* Recursive call on the new id of the node. */
-    min_heap_heapify (heap, min);
+    return 1 + min_heap_heapify (heap, min);
+  }
+
+  return 0;
+}
+
+static void *
+min_heap_build_subtrees (void *data)
+{
+  BuildTask *task = data;
+  MinHeap *heap = &task->heap;
+  long last_parent = GET_PARENT_ID (heap->size - 1);
+  int depth = 0;
+
+  /* The descendants of the roots that are k levels below them have
+   * consecutive ids, from (first_root + 1) * 2^k - 1 up to
+   * (last_root + 2) * 2^k - 2. */
+  while ((((long) task->first_root + 1) << (depth + 1)) - 1 < heap->size)
+    depth++;
+
+  /* Build the subtrees level by level from the bottom, so that every level is
+   * copied and heapified in one sequential pass. */
+  for (int k = depth; k >= 0; k--) {
+    long first = (((long) task->first_root + 1) << k) - 1;
+    long last = (((long) task->last_root + 2) << k) - 2;
+
+    if (last >= heap->size)
+      last = heap->size - 1;
+
+    memcpy (heap->elems + first, task->array + first,
+            (last - first + 1) * sizeof (int));
+
+    if (last > last_parent)
+      last = last_parent;
+
+    for (long i = last; i >= first; i--) {
+      int levels = min_heap_heapify (heap, i);
+
+      STATS_ADD_DEPTH (heap, OP_BUILD, levels);
+    }
   }
+
+  return NULL;
 }
 
 MinHeap *
@@ -54,6 +135,9 @@ min_heap_new (int max_size)
   heap->size = 0;
   heap->elems = malloc (max_size * sizeof (int));
 
+  STATS_INIT (heap);
+  STATS_ADD (heap, STATS_ALLOCATIONS, 2);
+
   return heap;
 }
 
@@ -63,6 +147,8 @@ min_heap_new_from_array (int *array,
 {
   MinHeap *heap = min_heap_new (size);
 
+  STATS_TIME_OP (heap, OP_BUILD);
+
   for (int i = 0; i < size; i++)
     heap->elems[i] = array[i];
 
@@ -71,12 +157,111 @@ min_heap_new_from_array (int *array,
 
   /* Start from the parent of the last node (there is no point to heapify the
    * nodes on the last level) and heapify all the nodes up to the root. */
-  for (int i = GET_PARENT_ID (size - 1); i >= 0; i--)
-    min_heap_heapify (heap, i);
+  for (int i = GET_PARENT_ID (size - 1); i >= 0; i--) {
+    int levels = min_heap_heapify (heap, i);
+
+    STATS_ADD_DEPTH (heap, OP_BUILD, levels);
+  }
 
   return heap;
 }
 
+/* Builds the heap like min_heap_new_from_array(), but on n_threads threads.
+ * The subtrees rooted on a level with enough nodes are independent of each
+ * other, so they are built concurrently. Only the few levels above them are
+ * left to build serially. */
+MinHeap *
+min_heap_new_from_array_parallel (int *array,
+                                  int  size,
+                                  int  n_threads)
+{
+  MinHeap *heap;
+  BuildTask *tasks;
+  int first_root;
+  int n_roots;
+
+  if (n_threads <= 1 || size < PARALLEL_BUILD_MIN_SIZE)
+    return min_heap_new_from_array (array, size);
+
+  if (n_threads > PARALLEL_BUILD_MAX_THREADS)
+    n_threads = PARALLEL_BUILD_MAX_THREADS;
+
+  heap = min_heap_new (size);
+  heap->size = size;
+
+  STATS_TIME_OP (heap, OP_BUILD);
+
+  /* Find the first level with enough subtrees for every thread. The level
+   * with 2^k nodes starts at id 2^k - 1. */
+  for (n_roots = 1; n_roots < n_threads * PARALLEL_BUILD_SUBTREES_PER_THREAD; n_roots *= 2);
+  first_root = n_roots - 1;
+
+  /* Make sure that the level is complete. */
+  while (first_root + n_roots > size) {
+    n_roots /= 2;
+    first_root = n_roots - 1;
+  }
+
+  if (n_threads > n_roots)
+    n_threads = n_roots;
+
+  /* Split the roots in consecutive ranges, one for every thread. */
+  tasks = malloc (n_threads * sizeof (BuildTask));
+
+  for (int i = 0; i < n_threads; i++) {
+    tasks[i].heap = *heap;
+    STATS_INIT (&tasks[i].heap);
+    tasks[i].array = array;
+    tasks[i].first_root = first_root + (long) n_roots * i / n_threads;
+    tasks[i].last_root = first_root + (long) n_roots * (i + 1) / n_threads - 1;
+  }
+
+  /* The current thread builds the first range itself, as well as the ranges
+   * of the threads that could not be started. */
+  for (int i = 1; i < n_threads; i++)
+    tasks[i].started = pthread_create (&tasks[i].thread, NULL,
+                                       min_heap_build_subtrees, &tasks[i]) == 0;
+
+  min_heap_build_subtrees (&tasks[0]);
+
+  for (int i = 1; i < n_threads; i++) {
+    if (tasks[i].started)
+      pthread_join (tasks[i].thread, NULL);
+    else
+      min_heap_build_subtrees (&tasks[i]);
+  }
+
+  for (int i = 0; i < n_threads; i++)
+    STATS_MERGE (heap, &tasks[i].heap);
+
+  free (tasks);
+
+  /* Finish the levels above the subtrees serially. */
+  memcpy (heap->elems, array, first_root * sizeof (int));
+
+  for (int i = first_root - 1; i >= 0; i--) {
+    int levels = min_heap_heapify (heap, i);
+
+    STATS_ADD_DEPTH (heap, OP_BUILD, levels);
+  }
+
+  return heap;
+}
+
+/* Restores the heap condition on the whole heap, whatever the order of its
+ * elements. */
+void
+min_heap_rebuild (MinHeap *heap)
+{
+  STATS_TIME_OP (heap, OP_BUILD);
+
+  for (int i = GET_PARENT_ID (heap->size - 1); i >= 0; i--) {
+    int levels = min_heap_heapify (heap, i);
+
+    STATS_ADD_DEPTH (heap, OP_BUILD, levels);
+  }
+}
+
 void
 min_heap_free (MinHeap *heap)
 {
@@ -102,6 +287,9 @@ min_heap_insert (MinHeap *heap,
 {
   int i = heap->size++;
   int p = GET_PARENT_ID (i);
+  int levels = 0;
+
+  STATS_TIME_OP (heap, OP_INSERT);
 
   /* Add the new node to last position. */
   heap->elems[i] = data;
@@ -114,17 +302,28 @@ min_heap_insert (MinHeap *heap,
 
     i = p;
     p = GET_PARENT_ID (p);
+    levels++;
+
+    STATS_ADD (heap, STATS_COMPARISONS, 1);
+    STATS_ADD (heap, STATS_SWAPS, 1);
   }
+
+  /* The comparison that ended the loop, if any. */
+  STATS_ADD (heap, STATS_COMPARISONS, i > 0);
+  STATS_ADD_DEPTH (heap, OP_INSERT, levels);
 }
 
 int
 min_heap_pop (MinHeap *heap)
 {
   int retval;
+  int levels;
 
   if (heap->size == 0)
     return -1;
 
+  STATS_TIME_OP (heap, OP_POP);
+
   /* Save the root (the lowest element). */
   retval = heap->elems[0];
 
@@ -135,11 +334,22 @@ min_heap_pop (MinHeap *heap)
   heap->size--;
 
   /* Preserve the heap condition. */
-  min_heap_heapify (heap, 0);
+  levels = min_heap_heapify (heap, 0);
+  STATS_ADD_DEPTH (heap, OP_POP, levels);
 
   return retval;
 }
 
+/* Writes the operation counters and the sampled latency histograms of the
+ * heap, one per line. This does nothing unless the heap was built with
+ * ENABLE_STATS defined. */
+void
+min_heap_dump_stats (MinHeap *heap,
+                     FILE    *stream)
+{
+  STATS_DUMP (heap, op_names, stream);
+}
+
 void
 min_heap_sort_array (int *array,
                      int  size)
@@ -1,18 +1,25 @@
 #ifndef MIN_HEAP_H
 #define MIN_HEAP_H
 
+#include <stdio.h>
+
 typedef struct _MinHeap MinHeap;
 
-MinHeap *min_heap_new            (int max_size);
-MinHeap *min_heap_new_from_array (int *array,
-                                  int  size);
-void     min_heap_free           (MinHeap *heap);
-int      min_heap_get_size       (MinHeap *heap);
-int      min_heap_peek           (MinHeap *heap);
-void     min_heap_insert         (MinHeap *heap,
-                                  int      data);
-int      min_heap_pop            (MinHeap *heap);
-void     min_heap_sort_array     (int *array,
-                                  int  size);
+MinHeap *min_heap_new                     (int max_size);
+MinHeap *min_heap_new_from_array          (int *array,
+                                           int  size);
+MinHeap *min_heap_new_from_array_parallel (int *array,
+                                           int  size,
+                                           int  n_threads);
+void     min_heap_free                    (MinHeap *heap);
+int      min_heap_get_size                (MinHeap *heap);
+int      min_heap_peek                    (MinHeap *heap);
+void     min_heap_insert                  (MinHeap *heap,
+                                           int      data);
+int      min_heap_pop                     (MinHeap *heap);
+void     min_heap_sort_array              (int *array,
+                                           int  size);
+void     min_heap_dump_stats              (MinHeap *heap,
+                                           FILE    *stream);
 
 #endif
@@ -0,0 +1,290 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#include "radix-heap.h"
+
+/* A radix heap is a monotone priority queue: the keys that are inserted must
+ * never be lower than the last popped key. This is the case for event
+ * simulations and for Dijkstra-like algorithms, where the popped priorities
+ * only grow over time.
+ *
+ * The elements are kept in buckets, by the highest bit in which they differ
+ * from the last popped key (bucket 0 holds the elements equal to it). Since
+ * every element only moves towards lower buckets, it is moved at most once
+ * per bit of the key, so both insert and pop cost O(log C) amortized, where C
+ * is the range of the keys (i.e. O(number of bits of the key)). The buckets
+ * are plain arrays, so the memory is accessed almost sequentially.
+ *
+ * The lowest element is cached, so peeking costs a scan of the first
+ * non-empty bucket only once per redistribution of that bucket, and O(1)
+ * otherwise.
+ */
+
+/* The keys are stored as unsigned values with the sign bit flipped, which
+ * preserves the order of the signed values. */
+#define TO_KEY(DATA)  ((unsigned int) (DATA) ^ (1u << (sizeof (int) * CHAR_BIT - 1)))
+#define TO_DATA(KEY)  ((int) ((KEY) ^ (1u << (sizeof (int) * CHAR_BIT - 1))))
+
+#define N_BUCKETS (sizeof (int) * CHAR_BIT + 1)
+
+typedef struct {
+  int size;
+  int capacity;
+  unsigned int *elems;
+} Bucket;
+
+struct _RadixHeap {
+  int max_size;
+  int size;
+  unsigned int last;
+  /* The lowest key, valid only if has_min is set. */
+  int has_min;
+  unsigned int min;
+  Bucket buckets[N_BUCKETS];
+};
+
+static int
+radix_heap_get_bucket_id (RadixHeap    *heap,
+                          unsigned int  key)
+{
+  /* The number of the highest bit in which the key differs from the last
+   * popped key (1...32), or 0 if they are equal. */
+  if (key == heap->last)
+    return 0;
+
+  return sizeof (int) * CHAR_BIT - __builtin_clz (key ^ heap->last);
+}
+
+static void
+radix_heap_bucket_push (RadixHeap    *heap,
+                        Bucket       *bucket,
+                        unsigned int  key)
+{
+  if (bucket->size == bucket->capacity) {
+    /* Grow the bucket geometrically, but never past the size of the heap. */
+    int capacity = bucket->capacity == 0 ? 16 : 2 * bucket->capacity;
+
+    if (capacity > heap->max_size)
+      capacity = heap->max_size;
+    if (capacity <= bucket->size)
+      capacity = bucket->size + 1;
+
+    bucket->elems = realloc (bucket->elems, capacity * sizeof (unsigned int));
+    bucket->capacity = capacity;
+  }
+
+  bucket->elems[bucket->size++] = key;
+}
+
+static unsigned int
+radix_heap_bucket_get_min (Bucket *bucket)
+{
+  unsigned int min = bucket->elems[0];
+
+  for (int i = 1; i < bucket->size; i++)
+    if (bucket->elems[i] < min)
+      min = bucket->elems[i];
+
+  return min;
+}
+
+static Bucket *
+radix_heap_get_first_bucket (RadixHeap *heap)
+{
+  for (unsigned int i = 0; i < N_BUCKETS; i++)
+    if (heap->buckets[i].size > 0)
+      return &heap->buckets[i];
+
+  return NULL;
+}
+
+/**
+ * radix_heap_new:
+ * @max_size: The maximum number of elements of the heap. The memory of the
+ *            heap grows on demand, up to this size.
+ *
+ * Creates a new empty radix heap.
+ *
+ * Returns: The newly created heap.
+ */
+RadixHeap *
+radix_heap_new (int max_size)
+{
+  RadixHeap *heap = calloc (1, sizeof (RadixHeap));
+
+  heap->max_size = max_size;
+  heap->size = 0;
+  heap->last = TO_KEY (INT_MIN);
+
+  return heap;
+}
+
+/**
+ * radix_heap_new_from_array:
+ * @array: The initial elements of the heap.
+ * @size: The number of elements in the array.
+ *
+ * Creates a new radix heap holding the elements of the given array.
+ *
+ * Returns: The newly created heap.
+ */
+RadixHeap *
+radix_heap_new_from_array (int *array,
+                           int  size)
+{
+  RadixHeap *heap = radix_heap_new (size);
+
+  for (int i = 0; i < size; i++)
+    radix_heap_insert (heap, array[i]);
+
+  return heap;
+}
+
+/**
+ * radix_heap_free:
+ * @heap: A heap.
+ *
+ * Frees the memory of the heap.
+ */
+void
+radix_heap_free (RadixHeap *heap)
+{
+  for (unsigned int i = 0; i < N_BUCKETS; i++)
+    free (heap->buckets[i].elems);
+
+  free (heap);
+}
+
+/**
+ * radix_heap_get_size:
+ * @heap: A heap.
+ *
+ * Returns: The number of elements in the heap.
+ */
+int
+radix_heap_get_size (RadixHeap *heap)
+{
+  return heap->size;
+}
+
+/**
+ * radix_heap_peek:
+ * @heap: A heap.
+ *
+ * Gets the lowest element of the heap, without removing it.
+ *
+ * Returns: The lowest element, or -1 if the heap is empty.
+ */
+int
+radix_heap_peek (RadixHeap *heap)
+{
+  Bucket *bucket;
+
+  if (heap->size == 0)
+    return -1;
+
+  if (!heap->has_min) {
+    bucket = radix_heap_get_first_bucket (heap);
+
+    /* The elements of bucket 0 are all equal to the last popped key. */
+    if (bucket == &heap->buckets[0])
+      heap->min = heap->last;
+    else
+      heap->min = radix_heap_bucket_get_min (bucket);
+
+    heap->has_min = 1;
+  }
+
+  return TO_DATA (heap->min);
+}
+
+/**
+ * radix_heap_insert:
+ * @heap: A heap.
+ * @data: The new element. It must not be lower than the last popped element.
+ *
+ * Adds a new element to the heap.
+ */
+void
+radix_heap_insert (RadixHeap *heap,
+                   int        data)
+{
+  unsigned int key = TO_KEY (data);
+
+  /* Inserting a key lower than the last popped one breaks monotonicity. */
+  assert (key >= heap->last);
+
+  radix_heap_bucket_push (heap, &heap->buckets[radix_heap_get_bucket_id (heap, key)], key);
+
+  /* Keep the cached minimum up to date. */
+  if (heap->size == 0 || (heap->has_min && key < heap->min)) {
+    heap->min = key;
+    heap->has_min = 1;
+  }
+
+  heap->size++;
+}
+
+/**
+ * radix_heap_pop:
+ * @heap: A heap.
+ *
+ * Removes the lowest element of the heap.
+ *
+ * Returns: The lowest element, or -1 if the heap is empty.
+ */
+int
+radix_heap_pop (RadixHeap *heap)
+{
+  Bucket *bucket;
+
+  if (heap->size == 0)
+    return -1;
+
+  bucket = radix_heap_get_first_bucket (heap);
+
+  if (bucket != &heap->buckets[0]) {
+    /* The lowest element of the first non-empty bucket becomes the new last
+     * key. Every other element of that bucket differs from it in a lower bit,
+     * so redistributing them moves each one to a lower bucket. */
+    heap->last = heap->has_min ? heap->min : radix_heap_bucket_get_min (bucket);
+
+    for (int i = 0; i < bucket->size; i++) {
+      unsigned int key = bucket->elems[i];
+
+      radix_heap_bucket_push (heap, &heap->buckets[radix_heap_get_bucket_id (heap, key)], key);
+    }
+
+    bucket->size = 0;
+  }
+
+  /* Bucket 0 now holds at least the new last key. */
+  heap->buckets[0].size--;
+  heap->size--;
+
+  /* The next lowest key is only known if it is equal to this one. */
+  heap->has_min = heap->buckets[0].size > 0;
+  heap->min = heap->last;
+
+  return TO_DATA (heap->last);
+}
+
+/**
+ * radix_heap_sort_array:
+ * @array: The array to sort.
+ * @size: The number of elements in the array.
+ *
+ * Sorts the array in ascending order, using a radix heap.
+ */
+void
+radix_heap_sort_array (int *array,
+                       int  size)
+{
+  RadixHeap *heap = radix_heap_new_from_array (array, size);
+
+  for (int i = 0; i < size; i++)
+    array[i] = radix_heap_pop (heap);
+
+  radix_heap_free (heap);
+}
@@ -0,0 +1,18 @@
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+typedef struct _RadixHeap RadixHeap;
+
+RadixHeap *radix_heap_new            (int max_size);
+RadixHeap *radix_heap_new_from_array (int *array,
+                                      int  size);
+void       radix_heap_free           (RadixHeap *heap);
+int        radix_heap_get_size       (RadixHeap *heap);
+int        radix_heap_peek           (RadixHeap *heap);
+void       radix_heap_insert         (RadixHeap *heap,
+                                      int        data);
+int        radix_heap_pop            (RadixHeap *heap);
+void       radix_heap_sort_array     (int *array,
+                                      int  size);
+
+#endif
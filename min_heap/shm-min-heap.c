@@ -0,0 +1,353 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "min-heap-private.h"
+#include "shm-min-heap.h"
+
+/* A MinHeap shared by several processes. The heap and its elements live in a
+ * named POSIX shared memory object, laid out as a SharedRegion followed by
+ * the elements, and every operation is serialized by a process-shared mutex
+ * stored in the same region.
+ *
+ * Since the region may be mapped at a different address in every process,
+ * the elems pointer of the heap is only valid for the process holding the
+ * lock, which sets it right after taking the lock. The operations themselves
+ * are the ones of MinHeap.
+ */
+
+/* How long shm_min_heap_open() waits for another process to finish creating
+ * the heap. */
+#define OPEN_TIMEOUT_MS 1000
+
+#define SHM_MIN_HEAP_MAGIC 0x4d696e48
+
+/* The fields checked by shm_min_heap_open() come first, so that their offsets
+ * do not depend on the layout of the MinHeap, which changes with ENABLE_STATS
+ * for example. */
+typedef struct {
+  unsigned int    magic;
+  unsigned int    region_size;
+  int             initialized;
+  pthread_mutex_t lock;
+  MinHeap         heap;
+} SharedRegion;
+
+struct _ShmMinHeap {
+  SharedRegion *region;
+  size_t        length;
+};
+
+static void
+sleep_ms (long ms)
+{
+  struct timespec ts = { ms / 1000, (ms % 1000) * 1000000 };
+
+  nanosleep (&ts, NULL);
+}
+
+static MinHeap *
+shm_min_heap_lock (ShmMinHeap *heap)
+{
+  SharedRegion *region = heap->region;
+  int retval = pthread_mutex_lock (&region->lock);
+
+  if (retval != 0 && retval != EOWNERDEAD) {
+    errno = retval;
+    return NULL;
+  }
+
+  region->heap.elems = (int *) (region + 1);
+
+  if (retval == EOWNERDEAD) {
+    /* The previous owner died in the middle of an operation, which may have
+     * left a garbage element counted in the size, or an element duplicated
+     * and another one lost by a half-done swap. The elements cannot be
+     * recovered, but the heap condition can: rebuild the heap over whatever
+     * the elements are now. */
+    if (region->heap.size < 0)
+      region->heap.size = 0;
+    if (region->heap.size > region->heap.max_size)
+      region->heap.size = region->heap.max_size;
+
+    min_heap_rebuild (&region->heap);
+    pthread_mutex_consistent (&region->lock);
+  }
+
+  return &region->heap;
+}
+
+static void
+shm_min_heap_unlock (ShmMinHeap *heap)
+{
+  pthread_mutex_unlock (&heap->region->lock);
+}
+
+static int
+shm_min_heap_init (SharedRegion *region,
+                   int           max_size)
+{
+  pthread_mutexattr_t attr;
+  int retval;
+
+  pthread_mutexattr_init (&attr);
+  pthread_mutexattr_setpshared (&attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust (&attr, PTHREAD_MUTEX_ROBUST);
+  retval = pthread_mutex_init (&region->lock, &attr);
+  pthread_mutexattr_destroy (&attr);
+
+  if (retval != 0) {
+    errno = retval;
+    return -1;
+  }
+
+  region->magic = SHM_MIN_HEAP_MAGIC;
+  region->region_size = sizeof (SharedRegion);
+  region->heap.max_size = max_size;
+  region->heap.size = 0;
+
+  /* Let the other processes in. */
+  __atomic_store_n (&region->initialized, 1, __ATOMIC_RELEASE);
+
+  return 0;
+}
+
+/**
+ * shm_min_heap_open:
+ * @name: The name of the shared memory object, e.g. "/jobs".
+ * @max_size: The maximum number of elements of the heap. This is only used
+ *            by the process that creates the heap.
+ *
+ * Opens the shared heap with the given name, creating an empty one if it does
+ * not exist yet.
+ *
+ * Returns: The heap, or NULL on failure, with errno set.
+ */
+ShmMinHeap *
+shm_min_heap_open (const char *name,
+                   int         max_size)
+{
+  ShmMinHeap *heap;
+  SharedRegion *region;
+  struct stat st;
+  size_t length;
+  int fd;
+  int created = 1;
+  int waited = 0;
+
+  fd = shm_open (name, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+  if (fd < 0 && errno == EEXIST) {
+    fd = shm_open (name, O_RDWR, 0);
+    created = 0;
+  }
+
+  if (fd < 0)
+    return NULL;
+
+  if (created) {
+    length = sizeof (SharedRegion) + (size_t) max_size * sizeof (int);
+
+    if (ftruncate (fd, length) < 0)
+      goto fail;
+  } else {
+    /* The creator may not have set the size yet. */
+    for (;;) {
+      if (fstat (fd, &st) < 0)
+        goto fail;
+
+      if (st.st_size > 0)
+        break;
+
+      if (waited++ == OPEN_TIMEOUT_MS) {
+        errno = ETIMEDOUT;
+        goto fail;
+      }
+
+      sleep_ms (1);
+    }
+
+    if (st.st_size < (off_t) sizeof (SharedRegion)) {
+      errno = EINVAL;
+      goto fail;
+    }
+
+    length = st.st_size;
+  }
+
+  region = mmap (NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (region == MAP_FAILED)
+    goto fail;
+
+  close (fd);
+
+  if (created) {
+    if (shm_min_heap_init (region, max_size) < 0) {
+      munmap (region, length);
+      shm_unlink (name);
+      return NULL;
+    }
+  } else {
+    /* Wait for the creator to initialize the lock. */
+    while (!__atomic_load_n (&region->initialized, __ATOMIC_ACQUIRE)) {
+      if (waited++ == OPEN_TIMEOUT_MS) {
+        munmap (region, length);
+        errno = ETIMEDOUT;
+        return NULL;
+      }
+
+      sleep_ms (1);
+    }
+
+    /* Refuse heaps created by a build with a different layout, and headers
+     * that claim more elements than what is mapped. */
+    if (region->magic != SHM_MIN_HEAP_MAGIC ||
+        region->region_size != sizeof (SharedRegion) ||
+        region->heap.max_size < 0 ||
+        length < sizeof (SharedRegion) + (size_t) region->heap.max_size * sizeof (int)) {
+      munmap (region, length);
+      errno = EINVAL;
+      return NULL;
+    }
+  }
+
+  heap = malloc (sizeof (ShmMinHeap));
+  heap->region = region;
+  heap->length = length;
+
+  return heap;
+
+fail:
+  close (fd);
+  if (created)
+    shm_unlink (name);
+
+  return NULL;
+}
+
+/**
+ * shm_min_heap_close:
+ * @heap: A heap.
+ *
+ * Unmaps the heap from the current process. The heap itself, along with its
+ * elements, stays available for the other processes until it is unlinked.
+ */
+void
+shm_min_heap_close (ShmMinHeap *heap)
+{
+  munmap (heap->region, heap->length);
+  free (heap);
+}
+
+/**
+ * shm_min_heap_unlink:
+ * @name: The name of the shared memory object.
+ *
+ * Removes the name of the shared heap, so that the next call to
+ * shm_min_heap_open() creates a new one. The memory is released once every
+ * process has closed the heap.
+ *
+ * Returns: 0 on success, or -1 on failure, with errno set.
+ */
+int
+shm_min_heap_unlink (const char *name)
+{
+  return shm_unlink (name);
+}
+
+/**
+ * shm_min_heap_get_size:
+ * @heap: A heap.
+ *
+ * Returns: The number of elements in the heap.
+ */
+int
+shm_min_heap_get_size (ShmMinHeap *heap)
+{
+  return __atomic_load_n (&heap->region->heap.size, __ATOMIC_RELAXED);
+}
+
+/**
+ * shm_min_heap_peek:
+ * @heap: A heap.
+ *
+ * Gets the lowest element of the heap, without removing it. Another process
+ * may pop it right after this call returns.
+ *
+ * Returns: The lowest element, or -1 if the heap is empty or cannot be
+ *          locked.
+ */
+int
+shm_min_heap_peek (ShmMinHeap *heap)
+{
+  MinHeap *shared = shm_min_heap_lock (heap);
+  int retval;
+
+  if (shared == NULL)
+    return -1;
+
+  retval = min_heap_get_size (shared) > 0 ? min_heap_peek (shared) : -1;
+
+  shm_min_heap_unlock (heap);
+
+  return retval;
+}
+
+/**
+ * shm_min_heap_insert:
+ * @heap: A heap.
+ * @data: The new element.
+ *
+ * Adds a new element to the heap.
+ *
+ * Returns: 0 on success, or -1 if the heap is full or cannot be locked.
+ */
+int
+shm_min_heap_insert (ShmMinHeap *heap,
+                     int         data)
+{
+  MinHeap *shared = shm_min_heap_lock (heap);
+  int retval = -1;
+
+  if (shared == NULL)
+    return -1;
+
+  if (shared->size < shared->max_size) {
+    min_heap_insert (shared, data);
+    retval = 0;
+  }
+
+  shm_min_heap_unlock (heap);
+
+  return retval;
+}
+
+/**
+ * shm_min_heap_pop:
+ * @heap: A heap.
+ *
+ * Removes the lowest element of the heap.
+ *
+ * Returns: The lowest element, or -1 if the heap is empty or cannot be
+ *          locked.
+ */
+int
+shm_min_heap_pop (ShmMinHeap *heap)
+{
+  MinHeap *shared = shm_min_heap_lock (heap);
+  int retval;
+
+  if (shared == NULL)
+    return -1;
+
+  retval = min_heap_pop (shared);
+
+  shm_min_heap_unlock (heap);
+
+  return retval;
+}
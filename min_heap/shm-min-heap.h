@@ -0,0 +1,16 @@
+#ifndef SHM_MIN_HEAP_H
+#define SHM_MIN_HEAP_H
+
+typedef struct _ShmMinHeap ShmMinHeap;
+
+ShmMinHeap *shm_min_heap_open     (const char *name,
+                                   int         max_size);
+void        shm_min_heap_close    (ShmMinHeap *heap);
+int         shm_min_heap_unlink   (const char *name);
+int         shm_min_heap_get_size (ShmMinHeap *heap);
+int         shm_min_heap_peek     (ShmMinHeap *heap);
+int         shm_min_heap_insert   (ShmMinHeap *heap,
+                                   int         data);
+int         shm_min_heap_pop      (ShmMinHeap *heap);
+
+#endif
@@ -0,0 +1,155 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "min-heap.h"
+#include "timer-wheel.h"
+
+/* Simulates a server with a million connections, each one with an idle
+ * timeout. At every tick, some connections see activity, so their timeout is
+ * cancelled and armed again. Expired connections are immediately replaced by
+ * new ones, so the number of pending timers stays constant.
+ *
+ * The same workload runs on the timer wheel and on a MinHeap keyed on the
+ * deadline. Since a MinHeap element cannot be removed, the heap cancels
+ * lazily: re-arming pushes a new element, and stale elements are discarded
+ * when they reach the top. To fit in an int, the heap element packs the
+ * deadline above the connection id, which limits the simulated time to
+ * MAX_TICK ticks.
+ */
+
+#define N_TIMERS    (1 << 20)
+#define ID_BITS     20
+#define MAX_TIMEOUT 1000
+#define N_TICKS     1000
+#define MAX_TICK    (MAX_TIMEOUT + N_TICKS)
+#define CHURN       20000
+
+typedef struct {
+  int    id;
+  Timer *timer;
+} Connection;
+
+static TimerWheel *wheel;
+static Connection *connections;
+static uint64_t now;
+
+static int
+get_timeout (void)
+{
+  return 1 + bench_rng () % MAX_TIMEOUT;
+}
+
+static void
+connection_timeout (void *data)
+{
+  Connection *connection = data;
+
+  /* Replace the connection with a new one. */
+  connection->timer = timer_wheel_schedule (wheel, now + get_timeout (),
+                                            connection_timeout, connection);
+}
+
+static void
+bench_timer_wheel (long *arms,
+                   long *fires)
+{
+  connections = malloc (N_TIMERS * sizeof (Connection));
+  wheel = timer_wheel_new (now = 0);
+
+  for (int i = 0; i < N_TIMERS; i++) {
+    connections[i].id = i;
+    connections[i].timer = timer_wheel_schedule (wheel, get_timeout (),
+                                                 connection_timeout,
+                                                 &connections[i]);
+  }
+
+  for (now = 1; now <= N_TICKS; now++) {
+    for (int i = 0; i < CHURN; i++) {
+      Connection *connection = &connections[bench_rng () % N_TIMERS];
+
+      timer_wheel_cancel (wheel, connection->timer);
+      connection->timer = timer_wheel_schedule (wheel, now + get_timeout (),
+                                                connection_timeout, connection);
+    }
+
+    *fires += timer_wheel_advance (wheel, now);
+  }
+
+  *arms = N_TIMERS + (long) N_TICKS * CHURN + *fires;
+
+  timer_wheel_free (wheel);
+  free (connections);
+}
+
+static void
+bench_min_heap (long *arms,
+                long *fires)
+{
+  /* The deadline each connection is currently armed for, or 0 if it fired. */
+  int *deadlines = malloc (N_TIMERS * sizeof (int));
+  MinHeap *heap = min_heap_new (N_TIMERS + 2 * N_TICKS * CHURN + N_TIMERS);
+
+  for (int i = 0; i < N_TIMERS; i++) {
+    deadlines[i] = get_timeout ();
+    min_heap_insert (heap, deadlines[i] << ID_BITS | i);
+  }
+
+  for (now = 1; now <= N_TICKS; now++) {
+    for (int i = 0; i < CHURN; i++) {
+      int id = bench_rng () % N_TIMERS;
+
+      deadlines[id] = now + get_timeout ();
+      min_heap_insert (heap, deadlines[id] << ID_BITS | id);
+    }
+
+    while (min_heap_get_size (heap) > 0 &&
+           (uint64_t) (min_heap_peek (heap) >> ID_BITS) <= now) {
+      int elem = min_heap_pop (heap);
+      int id = elem & ((1 << ID_BITS) - 1);
+
+      /* Skip the cancelled timers. */
+      if (deadlines[id] != elem >> ID_BITS)
+        continue;
+
+      deadlines[id] = now + get_timeout ();
+      min_heap_insert (heap, deadlines[id] << ID_BITS | id);
+      (*fires)++;
+    }
+  }
+
+  *arms = N_TIMERS + (long) N_TICKS * CHURN + *fires;
+
+  min_heap_free (heap);
+  free (deadlines);
+}
+
+static void
+run (const char *name,
+     void      (*bench) (long *, long *))
+{
+  long arms = 0;
+  long fires = 0;
+  double start;
+  double elapsed;
+
+  /* Both structures see the same sequence of timeouts. */
+  bench_seed (0);
+
+  start = bench_get_time_ns ();
+  bench (&arms, &fires);
+  elapsed = bench_get_time_ns () - start;
+
+  printf ("%-11s timers=%d ticks=%d arms=%ld fires=%ld total=%.1fms ns/arm=%.1f\n",
+          name, N_TIMERS, N_TICKS, arms, fires,
+          elapsed / 1e6, elapsed / arms);
+}
+
+int main (int argc, char **argv)
+{
+  run ("timer_wheel", bench_timer_wheel);
+  run ("min_heap", bench_min_heap);
+
+  return 0;
+}
@@ -0,0 +1,338 @@
+#include <stdlib.h>
+
+#include "timer-wheel.h"
+
+/* A hierarchical timing wheel, as described by Varghese and Lauck. Level 0 has
+ * one slot per tick, every slot of level 1 covers a whole turn of level 0, and
+ * so on. A timer is put on the lowest level that can represent its distance
+ * from the current tick. Every time a level completes a turn, the next slot of
+ * the upper level is cascaded, i.e. its timers are redistributed on the lower
+ * levels. Timers that are too far away for the highest level are kept on an
+ * overflow list, which is redistributed every time the highest level completes
+ * a turn.
+ *
+ * Scheduling and cancelling a timer is O(1), and all the timers expiring at
+ * the same tick are fired in one batch.
+ */
+
+#define WHEEL_BITS 8
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define N_LEVELS   4
+
+/* The index of the slot of the given level that covers the given tick. */
+#define GET_SLOT_ID(TICK, LEVEL) (((TICK) >> ((LEVEL) * WHEEL_BITS)) & WHEEL_MASK)
+
+struct _Timer {
+  Timer     *next;
+  /* NULL while the timer is firing. */
+  Timer    **pprev;
+  int        level;
+  uint64_t   deadline;
+  TimerFunc  func;
+  void      *data;
+};
+
+struct _TimerWheel {
+  /* The next tick to be processed. */
+  uint64_t  tick;
+  long      size;
+  Timer    *slots[N_LEVELS][WHEEL_SIZE];
+  Timer    *overflow;
+  /* The number of timers on every level, with the overflow list last. */
+  long      counts[N_LEVELS + 1];
+  /* Fired and cancelled timers, kept for reuse. */
+  Timer    *unused;
+};
+
+static void
+timer_list_add (Timer **list,
+                Timer  *timer)
+{
+  timer->next = *list;
+  timer->pprev = list;
+
+  if (*list != NULL)
+    (*list)->pprev = &timer->next;
+
+  *list = timer;
+}
+
+static void
+timer_list_remove (Timer *timer)
+{
+  *timer->pprev = timer->next;
+
+  if (timer->next != NULL)
+    timer->next->pprev = timer->pprev;
+}
+
+static void
+timer_list_free (Timer *list)
+{
+  while (list != NULL) {
+    Timer *next = list->next;
+
+    free (list);
+    list = next;
+  }
+}
+
+static void
+timer_wheel_add (TimerWheel *wheel,
+                 Timer      *timer)
+{
+  uint64_t deadline = timer->deadline;
+  uint64_t delta;
+  int level;
+
+  /* Timers that are already due go in the slot of the next tick. */
+  if (deadline < wheel->tick) {
+    timer->level = 0;
+    timer_list_add (&wheel->slots[0][GET_SLOT_ID (wheel->tick, 0)], timer);
+    wheel->counts[0]++;
+    return;
+  }
+
+  delta = deadline - wheel->tick;
+
+  for (level = 0; level < N_LEVELS; level++)
+    if (delta < (uint64_t) 1 << ((level + 1) * WHEEL_BITS))
+      break;
+
+  timer->level = level;
+  if (level < N_LEVELS)
+    timer_list_add (&wheel->slots[level][GET_SLOT_ID (deadline, level)], timer);
+  else
+    timer_list_add (&wheel->overflow, timer);
+  wheel->counts[level]++;
+}
+
+static void
+timer_wheel_redistribute (TimerWheel  *wheel,
+                          Timer      **list)
+{
+  Timer *timer = *list;
+
+  /* Detach the whole list first, since the timers may be added back to it. */
+  *list = NULL;
+
+  while (timer != NULL) {
+    Timer *next = timer->next;
+
+    wheel->counts[timer->level]--;
+    timer_wheel_add (wheel, timer);
+    timer = next;
+  }
+}
+
+static int
+timer_wheel_cascade (TimerWheel *wheel,
+                     int         level)
+{
+  int id = GET_SLOT_ID (wheel->tick, level);
+
+  timer_wheel_redistribute (wheel, &wheel->slots[level][id]);
+
+  /* When this is 0, the level has completed a turn as well. */
+  return id;
+}
+
+static void
+timer_wheel_release (TimerWheel *wheel,
+                     Timer      *timer)
+{
+  timer->next = wheel->unused;
+  wheel->unused = timer;
+}
+
+/**
+ * timer_wheel_new:
+ * @now: The current tick.
+ *
+ * Creates a new timer wheel with no timers.
+ *
+ * Returns: The newly created timer wheel.
+ */
+TimerWheel *
+timer_wheel_new (uint64_t now)
+{
+  TimerWheel *wheel = calloc (1, sizeof (TimerWheel));
+
+  wheel->tick = now;
+
+  return wheel;
+}
+
+/**
+ * timer_wheel_free:
+ * @wheel: A timer wheel.
+ *
+ * Frees the memory of the wheel. The pending timers are discarded without
+ * being fired.
+ */
+void
+timer_wheel_free (TimerWheel *wheel)
+{
+  for (int level = 0; level < N_LEVELS; level++)
+    for (int id = 0; id < WHEEL_SIZE; id++)
+      timer_list_free (wheel->slots[level][id]);
+
+  timer_list_free (wheel->overflow);
+  timer_list_free (wheel->unused);
+
+  free (wheel);
+}
+
+/**
+ * timer_wheel_get_size:
+ * @wheel: A timer wheel.
+ *
+ * Returns: The number of pending timers.
+ */
+long
+timer_wheel_get_size (TimerWheel *wheel)
+{
+  return wheel->size;
+}
+
+/**
+ * timer_wheel_schedule:
+ * @wheel: A timer wheel.
+ * @deadline: The tick at which the timer expires. If this tick has already
+ *            been processed, the timer fires at the next tick processed by
+ *            timer_wheel_advance(), i.e. on the first call whose @now is past
+ *            the last processed tick.
+ * @func: The function to call when the timer expires.
+ * @data: The data to pass to @func.
+ *
+ * Schedules a new timer.
+ *
+ * Returns: The timer, which can be passed to timer_wheel_cancel() for as long
+ *          as it has not fired yet.
+ */
+Timer *
+timer_wheel_schedule (TimerWheel *wheel,
+                      uint64_t    deadline,
+                      TimerFunc   func,
+                      void       *data)
+{
+  Timer *timer = wheel->unused;
+
+  if (timer != NULL)
+    wheel->unused = timer->next;
+  else
+    timer = malloc (sizeof (Timer));
+
+  timer->deadline = deadline;
+  timer->func = func;
+  timer->data = data;
+
+  timer_wheel_add (wheel, timer);
+  wheel->size++;
+
+  return timer;
+}
+
+/**
+ * timer_wheel_cancel:
+ * @wheel: A timer wheel.
+ * @timer: A pending timer of the wheel, or the timer that is firing.
+ *
+ * Cancels the timer. The timer must not be used after this call. Cancelling a
+ * timer from its own callback does nothing, since it has already expired.
+ */
+void
+timer_wheel_cancel (TimerWheel *wheel,
+                    Timer      *timer)
+{
+  if (timer->pprev == NULL)
+    return;
+
+  timer_list_remove (timer);
+  timer_wheel_release (wheel, timer);
+  wheel->counts[timer->level]--;
+  wheel->size--;
+}
+
+/**
+ * timer_wheel_advance:
+ * @wheel: A timer wheel.
+ * @now: The current tick.
+ *
+ * Processes every tick up to and including @now and fires the timers that
+ * expired, in order of their deadlines. The callbacks are free to schedule and
+ * cancel timers.
+ *
+ * Returns: The number of timers that were fired.
+ */
+long
+timer_wheel_advance (TimerWheel *wheel,
+                     uint64_t    now)
+{
+  long fired = 0;
+
+  while (wheel->tick <= now) {
+    int id = GET_SLOT_ID (wheel->tick, 0);
+    Timer *expired;
+    int level;
+
+    /* Nothing to cascade or fire, so jump straight to the end. */
+    if (wheel->size == 0) {
+      wheel->tick = now + 1;
+      break;
+    }
+
+    /* If the lower levels are empty, nothing happens until the next turn of
+     * the first non-empty level, so skip the ticks in between. */
+    for (level = 0; wheel->counts[level] == 0; level++);
+
+    if (level > 0) {
+      uint64_t mask = ((uint64_t) 1 << (level * WHEEL_BITS)) - 1;
+
+      if ((wheel->tick & mask) != 0) {
+        if ((wheel->tick | mask) >= now) {
+          wheel->tick = now + 1;
+          break;
+        }
+
+        wheel->tick = (wheel->tick | mask) + 1;
+        continue;
+      }
+    }
+
+    /* Whenever a level completes a turn, cascade the next slot of the upper
+     * level. When the highest level completes a turn too, bring in the
+     * overflowing timers that are now in range. */
+    if (id == 0 &&
+        timer_wheel_cascade (wheel, 1) == 0 &&
+        timer_wheel_cascade (wheel, 2) == 0 &&
+        timer_wheel_cascade (wheel, 3) == 0)
+      timer_wheel_redistribute (wheel, &wheel->overflow);
+
+    /* Detach the expired timers before firing them, so that the callbacks
+     * schedule new timers relative to the next tick. */
+    expired = wheel->slots[0][id];
+    wheel->slots[0][id] = NULL;
+    if (expired != NULL)
+      expired->pprev = &expired;
+
+    wheel->tick++;
+
+    while (expired != NULL) {
+      Timer *timer = expired;
+
+      timer_list_remove (timer);
+      timer->pprev = NULL;
+      wheel->counts[0]--;
+      wheel->size--;
+
+      timer->func (timer->data);
+
+      timer_wheel_release (wheel, timer);
+      fired++;
+    }
+  }
+
+  return fired;
+}
@@ -0,0 +1,23 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+typedef struct _Timer Timer;
+typedef struct _TimerWheel TimerWheel;
+
+typedef void (*TimerFunc) (void *);
+
+TimerWheel *timer_wheel_new      (uint64_t now);
+void        timer_wheel_free     (TimerWheel *wheel);
+long        timer_wheel_get_size (TimerWheel *wheel);
+Timer      *timer_wheel_schedule (TimerWheel *wheel,
+                                  uint64_t    deadline,
+                                  TimerFunc   func,
+                                  void       *data);
+void        timer_wheel_cancel   (TimerWheel *wheel,
+                                  Timer      *timer);
+long        timer_wheel_advance  (TimerWheel *wheel,
+                                  uint64_t    now);
+
+#endif